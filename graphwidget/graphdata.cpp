@@ -9,14 +9,14 @@ GraphData::GraphData(const QVector<QVector2D> data, const QVector3D color, float
     m_vbo.bind();
     m_vbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
 
-    if (m_capacity > 0) {
+    if (m_capacity > 0)
         m_vbo.allocate(m_capacity * sizeof(QVector2D));
-        if (!m_points.isEmpty()) {
-            m_vbo.write(0, m_points.constData(), m_points.size() * sizeof(QVector2D));
-        }
-    }
 
     m_vbo.release();
+
+    // В буфер попадают последние m_capacity точек, как в updateVBO
+    if (m_capacity > 0 && !m_points.isEmpty())
+        updateVBO();
 }
 
 GraphData::GraphData(const QVector3D color, float lineWidth, size_t capacity)
@@ -27,6 +27,32 @@ GraphData::~GraphData() {
         m_vbo.destroy();
 }
 
+// QOpenGLBuffer разделяет буфер между копиями, поэтому у источника забираем его,
+// оставляя несозданный — деструктор перемещённого объекта ничего не освобождает
+GraphData::GraphData(GraphData &&other) noexcept
+    : m_color{other.m_color}, m_lineWidth{other.m_lineWidth}, m_vbo{other.m_vbo}, m_capacity{other.m_capacity},
+    m_points{std::move(other.m_points)}, m_visible{other.m_visible}, m_isVBOStale{other.m_isVBOStale} {
+    other.m_vbo = QOpenGLBuffer{QOpenGLBuffer::VertexBuffer};
+}
+
+GraphData &GraphData::operator=(GraphData &&other) noexcept {
+    if (this == &other)
+        return *this;
+
+    if (m_vbo.isCreated())
+        m_vbo.destroy();
+
+    m_color = other.m_color;
+    m_lineWidth = other.m_lineWidth;
+    m_vbo = other.m_vbo;
+    m_capacity = other.m_capacity;
+    m_points = std::move(other.m_points);
+    m_visible = other.m_visible;
+    m_isVBOStale = other.m_isVBOStale;
+    other.m_vbo = QOpenGLBuffer{QOpenGLBuffer::VertexBuffer};
+    return *this;
+}
+
 void GraphData::setCapacity(int newCapacity) {
     m_capacity = std::max(1, newCapacity);
     m_points.resize(m_capacity);
@@ -40,7 +66,10 @@ void GraphData::setCapacity(int newCapacity) {
 
 void GraphData::setPoints(const QVector<QVector2D> &newPoints) {
     m_points = newPoints;
-    updateVBO();
+    if (m_visible)
+        updateVBO();
+    else
+        m_isVBOStale = true;
 }
 
 void GraphData::appendPoint(const QVector2D &point) {
@@ -49,18 +78,73 @@ void GraphData::appendPoint(const QVector2D &point) {
     if (m_capacity <= 0 || !m_vbo.isCreated())
         return;
 
-    m_vbo.bind();
-    if (m_size < m_capacity)
-        m_vbo.write(m_size * sizeof(QVector2D), &point, sizeof(QVector2D));
-    m_vbo.release();
+    if (!m_visible) {
+        m_isVBOStale = true;
+    } else {
+        m_vbo.bind();
+        if (m_size < m_capacity)
+            m_vbo.write(m_size * sizeof(QVector2D), &point, sizeof(QVector2D));
+        m_vbo.release();
+    }
 
     m_points.append(point);
 }
 
+void GraphData::appendPoints(const QVector2D *points, int count) {
+    size_t m_size = static_cast<size_t>(m_points.size());
+
+    if (count <= 0 || m_capacity <= 0 || !m_vbo.isCreated())
+        return;
+
+    // Одна запись в VBO на весь пакет вместо записи на каждую точку
+    if (!m_visible) {
+        m_isVBOStale = true;
+    } else {
+        m_vbo.bind();
+        if (m_size < m_capacity) {
+            const size_t toWrite = std::min(static_cast<size_t>(count), m_capacity - m_size);
+            m_vbo.write(m_size * sizeof(QVector2D), points, toWrite * sizeof(QVector2D));
+        }
+        m_vbo.release();
+    }
+
+    m_points.resize(m_size + count);
+    std::copy(points, points + count, m_points.begin() + m_size);
+}
+
 int GraphData::size() const {
     return m_points.size();
 }
 
+const QVector<QVector2D> &GraphData::points() const {
+    return m_points;
+}
+
+QVector3D GraphData::color() const {
+    return m_color;
+}
+
+float GraphData::lineWidth() const {
+    return m_lineWidth;
+}
+
+size_t GraphData::capacity() const {
+    return m_capacity;
+}
+
+// Скрытая серия не загружает точки в VBO; накопленное догружается одним вызовом при показе
+void GraphData::setVisible(bool visible) {
+    m_visible = visible;
+    if (m_visible && m_isVBOStale) {
+        m_isVBOStale = false;
+        updateVBO();
+    }
+}
+
+bool GraphData::isVisible() const {
+    return m_visible;
+}
+
 void GraphData::updateVBO() {
     if (!m_vbo.isCreated())
         return;
@@ -78,6 +162,9 @@ void GraphData::updateVBO() {
 }
 
 void GraphData::render(QOpenGLShaderProgram &p, int positionLoc) {
+    if (!m_visible)
+        return;
+
     p.setUniformValue("color", m_color);
     glLineWidth(m_lineWidth);
 
@@ -85,7 +172,7 @@ void GraphData::render(QOpenGLShaderProgram &p, int positionLoc) {
         p.enableAttributeArray(positionLoc);
         p.setAttributeBuffer(positionLoc, GL_FLOAT, 0, 2, 0);
 
-        glDrawArrays(GL_LINE_STRIP, 0, m_points.size());
+        glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(std::min(static_cast<size_t>(m_points.size()), m_capacity)));
 
         p.disableAttributeArray(positionLoc);
     m_vbo.release();
@@ -93,6 +180,7 @@ void GraphData::render(QOpenGLShaderProgram &p, int positionLoc) {
 
 void GraphData::clear(void) {
     m_points.clear();
+    m_isVBOStale = false;
     m_vbo.bind();
     m_vbo.write(0, nullptr, 0);
     m_vbo.release();
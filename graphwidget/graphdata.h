@@ -11,19 +11,30 @@ class GraphData {
 public:
     explicit GraphData(const QVector3D color = {1.0f, 0.0f, 1.0f}, float lineWidth = 1.0f, size_t capacity = 0);
     explicit GraphData(const QVector<QVector2D> data, const QVector3D color = {1.0f, 0.0f, 1.0f}, float lineWidth = 1.0f, size_t capacity = 0);
-    explicit GraphData(QVector<QVector2D> &data, const QVector3D color = {1.0f, 0.0f, 1.0f}, float lineWidth = 1.0f, size_t capacity = 0);
 
     ~GraphData();
 
+    GraphData(const GraphData &) = delete;
+    GraphData &operator=(const GraphData &) = delete;
+    GraphData(GraphData &&other) noexcept;
+    GraphData &operator=(GraphData &&other) noexcept;
+
     void setCapacity(int newCapacity);
     void setPoints(const QVector<QVector2D> &newPoints);
 
     void clear(void);
     void appendPoint(const QVector2D &point);
+    void appendPoints(const QVector2D *points, int count);
 
     int size() const;
 
+    void setVisible(bool visible);
+    bool isVisible() const;
+
     const QVector<QVector2D> &points() const;
+    QVector3D color() const;
+    float lineWidth() const;
+    size_t capacity() const;
 
     void render(QOpenGLShaderProgram &p, int positionLoc);
 
@@ -35,6 +46,8 @@ private:
     QOpenGLBuffer m_vbo;
     size_t m_capacity;
     QVector<QVector2D> m_points;
+    bool m_visible = true;
+    bool m_isVBOStale = false;
 };
 
 #endif // GRAPHDATA_H
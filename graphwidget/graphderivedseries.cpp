@@ -0,0 +1,406 @@
+#include "graphderivedseries.h"
+#include "graphwidget.h"
+
+#include <QTimer>
+#include <QtMath>
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GRAPHWIDGET_SSE2
+#endif
+
+namespace {
+constexpr int kMaxSpectrumLength = 1 << 20;
+
+// Векторные ядра: SSE2 по четыре значения, хвост — скалярно
+
+void minMaxKernel(const float *v, int n, float &outMin, float &outMax) {
+    float mn = v[0];
+    float mx = v[0];
+    int i = 0;
+#ifdef GRAPHWIDGET_SSE2
+    if (n >= 4) {
+        __m128 vmin = _mm_loadu_ps(v);
+        __m128 vmax = vmin;
+        for (i = 4; i + 4 <= n; i += 4) {
+            const __m128 x = _mm_loadu_ps(v + i);
+            vmin = _mm_min_ps(vmin, x);
+            vmax = _mm_max_ps(vmax, x);
+        }
+        alignas(16) float lo[4];
+        alignas(16) float hi[4];
+        _mm_store_ps(lo, vmin);
+        _mm_store_ps(hi, vmax);
+        mn = std::min({lo[0], lo[1], lo[2], lo[3]});
+        mx = std::max({hi[0], hi[1], hi[2], hi[3]});
+    }
+#endif
+    for (; i < n; ++i) {
+        mn = std::min(mn, v[i]);
+        mx = std::max(mx, v[i]);
+    }
+    outMin = mn;
+    outMax = mx;
+}
+
+float sumKernel(const float *v, int n) {
+    float sum = 0.0f;
+    int i = 0;
+#ifdef GRAPHWIDGET_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_add_ps(acc, _mm_loadu_ps(v + i));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; ++i)
+        sum += v[i];
+    return sum;
+}
+
+void multiplyKernel(const float *a, const float *b, float *out, int n) {
+    int i = 0;
+#ifdef GRAPHWIDGET_SSE2
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#endif
+    for (; i < n; ++i)
+        out[i] = a[i] * b[i];
+}
+
+int normalizeLength(GraphDerivedSeries::Kind kind, int length) {
+    if (kind == GraphDerivedSeries::Spectrum)
+        return static_cast<int>(qNextPowerOfTwo(static_cast<quint32>(qBound(2, length, kMaxSpectrumLength) - 1)));
+    return qMax(1, length);
+}
+}
+
+class GraphDerivedWorker : public QObject {
+    Q_OBJECT
+
+public:
+    GraphDerivedWorker(GraphDerivedSeries::Kind kind, int length);
+
+    void process(const QVector<QVector2D> &points);
+    void reset();
+
+signals:
+    void appended(const QVector<QVector2D> &points);
+    void replaced(const QVector<QVector2D> &points);
+    void resetDone();
+
+private:
+    void processMovingAverage(const QVector<QVector2D> &points);
+    void processBlocks(const QVector<QVector2D> &points);
+    void processSpectrum(const QVector<QVector2D> &points);
+    void fft(std::vector<std::complex<float>> &data) const;
+
+    GraphDerivedSeries::Kind m_kind;
+    int m_length;
+
+    // Кольцо последних m_length точек (скользящее среднее и спектр)
+    QVector<float> m_windowX;
+    QVector<float> m_windowY;
+    int m_windowPos = 0;
+    int m_windowCount = 0;
+    double m_windowSum = 0.0;
+
+    // Неполный блок (огибающая и прореживание)
+    QVector<float> m_blockX;
+    QVector<float> m_blockY;
+
+    // Спектр
+    QVector<float> m_hann;
+    float m_hannSum = 0.0f;
+    std::vector<std::complex<float>> m_twiddles;
+    int m_sinceSpectrum = 0;
+};
+
+GraphDerivedWorker::GraphDerivedWorker(GraphDerivedSeries::Kind kind, int length)
+    : m_kind{kind}, m_length{length} {
+
+    if (m_kind == GraphDerivedSeries::MovingAverage)
+        m_windowY.resize(m_length);
+
+    if (m_kind == GraphDerivedSeries::Spectrum) {
+        m_windowX.resize(m_length);
+        m_windowY.resize(m_length);
+
+        m_hann.resize(m_length);
+        for (int i = 0; i < m_length; ++i)
+            m_hann[i] = 0.5f - 0.5f * std::cos(2.0 * M_PI * i / (m_length - 1));
+        m_hannSum = sumKernel(m_hann.constData(), m_length);
+
+        m_twiddles.resize(m_length / 2);
+        for (int k = 0; k < m_length / 2; ++k)
+            m_twiddles[k] = std::polar(1.0f, static_cast<float>(-2.0 * M_PI * k / m_length));
+    }
+}
+
+void GraphDerivedWorker::process(const QVector<QVector2D> &points) {
+    switch (m_kind) {
+    case GraphDerivedSeries::MovingAverage:
+        processMovingAverage(points);
+        break;
+    case GraphDerivedSeries::Envelope:
+    case GraphDerivedSeries::Decimation:
+        processBlocks(points);
+        break;
+    case GraphDerivedSeries::Spectrum:
+        processSpectrum(points);
+        break;
+    }
+}
+
+void GraphDerivedWorker::reset() {
+    m_windowX.fill(0.0f);
+    m_windowY.fill(0.0f);
+    m_windowPos = 0;
+    m_windowCount = 0;
+    m_windowSum = 0.0;
+    m_blockX.clear();
+    m_blockY.clear();
+    m_sinceSpectrum = 0;
+
+    emit resetDone();
+}
+
+void GraphDerivedWorker::processMovingAverage(const QVector<QVector2D> &points) {
+    QVector<QVector2D> out;
+    out.reserve(points.size());
+
+    for (const QVector2D &point : points) {
+        if (m_windowCount == m_length)
+            m_windowSum -= m_windowY[m_windowPos];
+        else
+            ++m_windowCount;
+
+        m_windowY[m_windowPos] = point.y();
+        m_windowSum += point.y();
+        m_windowPos = (m_windowPos + 1) % m_length;
+
+        out.append(QVector2D(point.x(), static_cast<float>(m_windowSum / m_windowCount)));
+    }
+
+    emit appended(out);
+}
+
+void GraphDerivedWorker::processBlocks(const QVector<QVector2D> &points) {
+    for (const QVector2D &point : points) {
+        m_blockX.append(point.x());
+        m_blockY.append(point.y());
+    }
+
+    const int blocks = m_blockY.size() / m_length;
+    if (blocks == 0)
+        return;
+
+    QVector<QVector2D> out;
+    out.reserve(m_kind == GraphDerivedSeries::Envelope ? 2 * blocks : blocks);
+
+    for (int b = 0; b < blocks; ++b) {
+        const int first = b * m_length;
+        const float *y = m_blockY.constData() + first;
+        const float x = 0.5f * (m_blockX[first] + m_blockX[first + m_length - 1]);
+
+        if (m_kind == GraphDerivedSeries::Envelope) {
+            // Минимум и максимум на одной абсциссе — ломаная рисует полосу огибающей
+            float mn, mx;
+            minMaxKernel(y, m_length, mn, mx);
+            out.append(QVector2D(x, mn));
+            out.append(QVector2D(x, mx));
+        } else {
+            out.append(QVector2D(x, sumKernel(y, m_length) / m_length));
+        }
+    }
+
+    m_blockX.remove(0, blocks * m_length);
+    m_blockY.remove(0, blocks * m_length);
+
+    emit appended(out);
+}
+
+void GraphDerivedWorker::processSpectrum(const QVector<QVector2D> &points) {
+    for (const QVector2D &point : points) {
+        m_windowX[m_windowPos] = point.x();
+        m_windowY[m_windowPos] = point.y();
+        m_windowPos = (m_windowPos + 1) % m_length;
+        m_windowCount = qMin(m_windowCount + 1, m_length);
+    }
+    m_sinceSpectrum += points.size();
+
+    // Пересчёт раз в пол-окна, и не чаще одного раза на пакет
+    if (m_windowCount < m_length || m_sinceSpectrum < m_length / 2)
+        return;
+    m_sinceSpectrum = 0;
+
+    // Самая старая точка кольца — на позиции записи
+    QVector<float> ordered(m_length);
+    const int tail = m_length - m_windowPos;
+    std::copy_n(m_windowY.constData() + m_windowPos, tail, ordered.data());
+    std::copy_n(m_windowY.constData(), m_windowPos, ordered.data() + tail);
+    multiplyKernel(ordered.constData(), m_hann.constData(), ordered.data(), m_length);
+
+    std::vector<std::complex<float>> data(ordered.constBegin(), ordered.constEnd());
+    fft(data);
+
+    const float oldestX = m_windowX[m_windowPos];
+    const float newestX = m_windowX[(m_windowPos + m_length - 1) % m_length];
+    const float dx = (newestX - oldestX) / (m_length - 1);
+    const float binWidth = (dx > 0.0f) ? 1.0f / (m_length * dx) : 1.0f;
+
+    const int bins = m_length / 2 + 1;
+    QVector<QVector2D> out(bins);
+    for (int k = 0; k < bins; ++k) {
+        const float scale = (k == 0 || k == m_length / 2) ? 1.0f : 2.0f;
+        out[k] = QVector2D(k * binWidth, scale * std::abs(data[k]) / m_hannSum);
+    }
+
+    emit replaced(out);
+}
+
+// Итеративное БПФ по основанию 2, длина — степень двойки
+void GraphDerivedWorker::fft(std::vector<std::complex<float>> &data) const {
+    const int n = static_cast<int>(data.size());
+
+    for (int i = 1, j = 0; i < n; ++i) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        const int half = len / 2;
+        const int step = n / len;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < half; ++j) {
+                const std::complex<float> u = data[i + j];
+                const std::complex<float> v = data[i + j + half] * m_twiddles[j * step];
+                data[i + j] = u + v;
+                data[i + j + half] = u - v;
+            }
+        }
+    }
+}
+
+GraphDerivedSeries::GraphDerivedSeries(GraphWidget *sourceWidget, int sourceGraphId, GraphWidget *targetWidget,
+                                       Kind kind, int length,
+                                       const QVector3D color, float lineWidth, QObject *parent)
+    : QObject(parent),
+    m_sourceWidget{sourceWidget},
+    m_targetWidget{targetWidget ? targetWidget : sourceWidget},
+    m_sourceGraphId{sourceGraphId},
+    m_graphId{-1},
+    m_kind{kind},
+    m_length{normalizeLength(kind, length)},
+    m_worker{new GraphDerivedWorker(m_kind, m_length)} {
+
+    qRegisterMetaType<QVector<QVector2D>>();
+
+    if (m_kind == Spectrum && m_targetWidget == m_sourceWidget)
+        qWarning("Spectrum shares the source widget axes; pass a separate target widget");
+
+    if (m_targetWidget) {
+        // Среднее даёт по точке на точку источника, огибающая и прореживание — меньше,
+        // поэтому ёмкости исходной серии достаточно
+        size_t capacity = static_cast<size_t>(m_length / 2 + 1);
+        if (m_kind != Spectrum)
+            capacity = m_sourceWidget ? m_sourceWidget->graphCapacity(m_sourceGraphId) : 0;
+        m_graphId = m_targetWidget->addGraph(color, lineWidth, capacity);
+    }
+    if (m_sourceWidget) {
+        connect(m_sourceWidget, &GraphWidget::pointsAppended, this, &GraphDerivedSeries::onPointsAppended);
+        connect(m_sourceWidget, &GraphWidget::graphCleared, this, &GraphDerivedSeries::onSourceCleared);
+    }
+
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &GraphDerivedWorker::appended, this, &GraphDerivedSeries::onAppended);
+    connect(m_worker, &GraphDerivedWorker::replaced, this, &GraphDerivedSeries::onReplaced);
+    connect(m_worker, &GraphDerivedWorker::resetDone, this, &GraphDerivedSeries::onResetDone);
+    m_thread.start();
+}
+
+// Серия остаётся в целевом виджете; удалить её можно через GraphWidget::removeGraph(graphId())
+GraphDerivedSeries::~GraphDerivedSeries() {
+    m_thread.quit();
+    m_thread.wait();
+}
+
+int GraphDerivedSeries::graphId() const {
+    return m_graphId;
+}
+
+int GraphDerivedSeries::sourceGraphId() const {
+    return m_sourceGraphId;
+}
+
+GraphWidget *GraphDerivedSeries::targetWidget() const {
+    return m_targetWidget;
+}
+
+GraphDerivedSeries::Kind GraphDerivedSeries::kind() const {
+    return m_kind;
+}
+
+int GraphDerivedSeries::length() const {
+    return m_length;
+}
+
+void GraphDerivedSeries::onPointsAppended(int graphId, const QVector<QVector2D> &points) {
+    if (graphId != m_sourceGraphId || points.isEmpty())
+        return;
+
+    // Точки, пришедшие за один проход цикла событий, уходят в воркер одним пакетом
+    m_pending.append(points);
+    if (!m_isFlushScheduled) {
+        m_isFlushScheduled = true;
+        QTimer::singleShot(0, this, &GraphDerivedSeries::flushPending);
+    }
+}
+
+void GraphDerivedSeries::flushPending() {
+    m_isFlushScheduled = false;
+    if (m_pending.isEmpty())
+        return;
+
+    QVector<QVector2D> points;
+    points.swap(m_pending);
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, points] { worker->process(points); }, Qt::QueuedConnection);
+}
+
+// Результаты, посчитанные до сброса, ещё могут быть в очереди — они отбрасываются до resetDone
+void GraphDerivedSeries::onSourceCleared(int graphId) {
+    if (graphId != m_sourceGraphId)
+        return;
+
+    m_pending.clear();
+    ++m_pendingResets;
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker] { worker->reset(); }, Qt::QueuedConnection);
+
+    if (m_targetWidget)
+        m_targetWidget->clearGraph(m_graphId);
+}
+
+void GraphDerivedSeries::onResetDone() {
+    --m_pendingResets;
+}
+
+void GraphDerivedSeries::onAppended(const QVector<QVector2D> &points) {
+    if (m_targetWidget && m_pendingResets == 0)
+        m_targetWidget->addPointsToGraph(m_graphId, points);
+}
+
+void GraphDerivedSeries::onReplaced(const QVector<QVector2D> &points) {
+    if (m_targetWidget && m_pendingResets == 0)
+        m_targetWidget->setGraphPoints(m_graphId, points);
+}
+
+#include "graphderivedseries.moc"
@@ -0,0 +1,61 @@
+#ifndef GRAPHDERIVEDSERIES_H
+#define GRAPHDERIVEDSERIES_H
+
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QVector>
+#include <QVector2D>
+#include <QVector3D>
+
+class GraphWidget;
+class GraphDerivedWorker;
+
+// Производная серия: вычисляется в отдельном потоке по мере поступления точек в исходную серию
+// и добавляется в целевой виджет пакетами. Сама является обычной серией целевого виджета (graphId()).
+// Целевой виджет может совпадать с исходным; спектру нужен отдельный — у него другие оси.
+class GraphDerivedSeries : public QObject {
+    Q_OBJECT
+
+public:
+    enum Kind {
+        MovingAverage,  // скользящее среднее по length точкам
+        Envelope,       // минимум и максимум каждого блока из length точек
+        Decimation,     // среднее каждого блока из length точек
+        Spectrum        // амплитудный спектр последних length точек (окно Ханна), length округляется до степени двойки
+    };
+
+    explicit GraphDerivedSeries(GraphWidget *sourceWidget, int sourceGraphId, GraphWidget *targetWidget,
+                                Kind kind, int length,
+                                const QVector3D color = {0.0f, 1.0f, 1.0f}, float lineWidth = 1.0f,
+                                QObject *parent = nullptr);
+    ~GraphDerivedSeries() override;
+
+    int graphId() const;
+    int sourceGraphId() const;
+    GraphWidget *targetWidget() const;
+    Kind kind() const;
+    int length() const;
+
+private:
+    void onPointsAppended(int graphId, const QVector<QVector2D> &points);
+    void flushPending();
+    void onSourceCleared(int graphId);
+    void onResetDone();
+    void onAppended(const QVector<QVector2D> &points);
+    void onReplaced(const QVector<QVector2D> &points);
+
+    QPointer<GraphWidget> m_sourceWidget;
+    QPointer<GraphWidget> m_targetWidget;
+    int m_sourceGraphId;
+    int m_graphId;
+    Kind m_kind;
+    int m_length;
+    QThread m_thread;
+    GraphDerivedWorker *m_worker;
+    QVector<QVector2D> m_pending;
+    bool m_isFlushScheduled = false;
+    int m_pendingResets = 0;
+};
+
+#endif // GRAPHDERIVEDSERIES_H
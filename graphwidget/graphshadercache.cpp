@@ -0,0 +1,67 @@
+#include "graphshadercache.h"
+
+#include <QOpenGLShader>
+
+namespace {
+const char *kVertexShaderSource = R"(
+    #version 330 core
+    layout(location = 0) in vec2 position;
+    uniform mat4 transform;
+    void main() {
+        gl_Position = transform * vec4(position, 0.0, 1.0);
+    }
+)";
+
+const char *kFragmentShaderSource = R"(
+    #version 330 core
+    uniform vec3 color;
+    out vec4 fragColor;
+    void main() {
+        fragColor = vec4(color, 1.0);
+    }
+)";
+}
+
+GraphShaderCache::~GraphShaderCache() {
+    clear();
+}
+
+// Неудачная сборка тоже запоминается, чтобы не повторять её и предупреждение на каждом кадре
+QOpenGLShaderProgram *GraphShaderCache::program() {
+    if (!m_isBuilt) {
+        m_program = build();
+        m_isBuilt = true;
+    }
+    return m_program;
+}
+
+void GraphShaderCache::setDiskCacheEnabled(bool is) {
+    m_isDiskCacheEnabled = is;
+}
+
+void GraphShaderCache::clear() {
+    delete m_program;
+    m_program = nullptr;
+    m_isBuilt = false;
+}
+
+QOpenGLShaderProgram *GraphShaderCache::build() {
+    auto *p = new QOpenGLShaderProgram;
+    bool isOk;
+    // Кэшируемые шейдеры Qt собирает из сохранённого двоичного образа программы, если он есть
+    if (m_isDiskCacheEnabled) {
+        isOk = p->addCacheableShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShaderSource)
+               && p->addCacheableShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShaderSource);
+    } else {
+        isOk = p->addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShaderSource)
+               && p->addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShaderSource);
+    }
+
+    if (!isOk || !p->link()) {
+        qWarning("Error while creating shader program");
+        delete p;
+        return nullptr;
+    }
+
+    return p;
+}
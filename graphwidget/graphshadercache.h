@@ -0,0 +1,33 @@
+#ifndef GRAPHSHADERCACHE_H
+#define GRAPHSHADERCACHE_H
+
+#include <QOpenGLShaderProgram>
+
+// Шейдерная программа виджета. Собирается лениво при первом запросе и живёт до clear();
+// двоичный образ программы кэшируется Qt на диске, чтобы не компилировать шейдеры в каждом виджете.
+class GraphShaderCache {
+public:
+    GraphShaderCache() = default;
+    ~GraphShaderCache();
+
+    GraphShaderCache(const GraphShaderCache &) = delete;
+    GraphShaderCache &operator=(const GraphShaderCache &) = delete;
+
+    // Требует текущего контекста OpenGL; nullptr, если программу собрать не удалось
+    QOpenGLShaderProgram *program();
+
+    // Двоичный кэш программ на диске (glGetProgramBinary через QOpenGLShaderProgram)
+    void setDiskCacheEnabled(bool is);
+
+    // Требует текущего контекста OpenGL
+    void clear();
+
+private:
+    QOpenGLShaderProgram *build();
+
+    QOpenGLShaderProgram *m_program = nullptr;
+    bool m_isBuilt = false;
+    bool m_isDiskCacheEnabled = true;
+};
+
+#endif // GRAPHSHADERCACHE_H
@@ -0,0 +1,242 @@
+#include "graphwidget.h"
+#include "graphsnapshot.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QtMath>
+#include <climits>
+#include <cstring>
+
+namespace {
+qint64 alignUp(qint64 pos) {
+    return (pos + kGraphSnapshotAlignment - 1) / kGraphSnapshotAlignment * kGraphSnapshotAlignment;
+}
+
+bool isAllFinite(const float *v, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (!qIsFinite(v[i]))
+            return false;
+    }
+    return true;
+}
+
+// Разбор отображённого в память файла. Состояние виджета не трогается, пока весь файл не проверен.
+bool readSnapshot(const uchar *base, qint64 fileSize, GraphSnapshotHeader &header,
+                  QVector<GraphSnapshotSeries> &series, QVector<QVector<QVector2D>> &data) {
+    const auto isInFile = [fileSize](quint64 offset, quint64 size) {
+        return offset <= quint64(fileSize) && size <= quint64(fileSize) - offset;
+    };
+
+    if (!isInFile(0, sizeof(GraphSnapshotHeader)))
+        return false;
+    std::memcpy(&header, base, sizeof(GraphSnapshotHeader));
+    if (header.magic != kGraphSnapshotMagic || header.version != kGraphSnapshotVersion)
+        return false;
+    if (header.nextGraphId < 0 || !isAllFinite(header.zoom, 2) || !isAllFinite(header.offset, 2)
+        || !isAllFinite(header.chartRect, 4) || !qIsFinite(header.lastVisiblePeriod) || header.lastVisiblePeriod < 0.0f)
+        return false;
+
+    if (!isInFile(sizeof(GraphSnapshotHeader), quint64(header.graphCount) * sizeof(GraphSnapshotSeries)))
+        return false;
+    series.resize(header.graphCount);
+    std::memcpy(series.data(), base + sizeof(GraphSnapshotHeader), header.graphCount * sizeof(GraphSnapshotSeries));
+
+    QSet<qint32> ids;
+    data.resize(header.graphCount);
+    for (quint32 i = 0; i < header.graphCount; ++i) {
+        const GraphSnapshotSeries &s = series[i];
+        // Идентификатор должен оставлять место для nextGraphId, а буфер GPU — помещаться в int байт
+        if (s.id < 0 || s.id == INT_MAX || ids.contains(s.id)
+            || s.capacity > quint64(INT_MAX) / sizeof(QVector2D)
+            || !isInFile(s.chunkTableOffset, quint64(s.chunkCount) * sizeof(GraphSnapshotChunk)))
+            return false;
+        ids.insert(s.id);
+
+        QVector<GraphSnapshotChunk> chunks(s.chunkCount);
+        std::memcpy(chunks.data(), base + s.chunkTableOffset, s.chunkCount * sizeof(GraphSnapshotChunk));
+
+        quint64 total = 0;
+        for (const GraphSnapshotChunk &chunk : chunks) {
+            if (chunk.pointCount > kGraphSnapshotChunkPoints || !isInFile(chunk.offset, chunk.storedSize))
+                return false;
+            total += chunk.pointCount;
+        }
+        if (total != s.pointCount)
+            return false;
+
+        QVector<QVector2D> &points = data[i];
+        points.resize(static_cast<qsizetype>(s.pointCount));
+        qsizetype filled = 0;
+        for (const GraphSnapshotChunk &chunk : chunks) {
+            const qsizetype rawSize = qsizetype(chunk.pointCount) * qsizetype(sizeof(QVector2D));
+            if (chunk.isCompressed) {
+                const QByteArray raw = qUncompress(base + chunk.offset, chunk.storedSize);
+                if (raw.size() != rawSize)
+                    return false;
+                std::memcpy(points.data() + filled, raw.constData(), rawSize);
+            } else {
+                if (chunk.storedSize != rawSize)
+                    return false;
+                std::memcpy(points.data() + filled, base + chunk.offset, rawSize);
+            }
+            filled += chunk.pointCount;
+        }
+    }
+
+    return true;
+}
+}
+
+bool GraphWidget::saveSnapshot(const QString &fileName, bool isCompressed) const {
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Cannot open snapshot file for writing");
+        return false;
+    }
+
+    const quint32 graphCount = static_cast<quint32>(graphs.size());
+
+    GraphSnapshotHeader header{};
+    header.magic = kGraphSnapshotMagic;
+    header.version = kGraphSnapshotVersion;
+    header.graphCount = graphCount;
+    header.nextGraphId = nextGraphId;
+    header.zoom[0] = zoom.x();
+    header.zoom[1] = zoom.y();
+    header.offset[0] = offset.x();
+    header.offset[1] = offset.y();
+    header.chartRect[0] = chartRect.x();
+    header.chartRect[1] = chartRect.y();
+    header.chartRect[2] = chartRect.width();
+    header.chartRect[3] = chartRect.height();
+    header.lastVisiblePeriod = lastVisiblePeriod;
+    header.isAutoScale = isAutoScale;
+    header.isFollow = isFollow;
+    header.isAutoScaleY = isAutoScaleY;
+    header.isPointsPresent = isPointsPresent;
+
+    // Таблицы заполняются по ходу записи блоков и дописываются в начало файла в конце
+    QVector<GraphSnapshotSeries> series(graphCount);
+    QVector<GraphSnapshotChunk> chunks;
+    qint64 tableOffset = sizeof(GraphSnapshotHeader) + qint64(graphCount) * sizeof(GraphSnapshotSeries);
+    for (quint32 slot = 0; slot < graphCount; ++slot) {
+        const GraphData &graph = graphs[slot];
+        const QVector3D color = graph.color();
+        const quint32 chunkCount = (graph.size() + kGraphSnapshotChunkPoints - 1) / kGraphSnapshotChunkPoints;
+
+        series[slot] = GraphSnapshotSeries{slotIds[slot], slotZOrders[slot], {color.x(), color.y(), color.z()},
+                                           graph.lineWidth(), graph.capacity(), quint64(graph.size()),
+                                           quint64(tableOffset), chunkCount, graph.isVisible()};
+        tableOffset += qint64(chunkCount) * sizeof(GraphSnapshotChunk);
+    }
+
+    file.write(QByteArray(alignUp(tableOffset), '\0'));
+
+    for (quint32 slot = 0; slot < graphCount; ++slot) {
+        const QVector<QVector2D> &points = graphs[slot].points();
+        for (qsizetype first = 0; first < points.size(); first += kGraphSnapshotChunkPoints) {
+            const qsizetype count = qMin<qsizetype>(kGraphSnapshotChunkPoints, points.size() - first);
+            const auto *raw = reinterpret_cast<const uchar *>(points.constData() + first);
+            const qsizetype rawSize = count * qsizetype(sizeof(QVector2D));
+
+            // Сжатие быстрым уровнем; блок, который не ужался, хранится как есть
+            QByteArray packed;
+            if (isCompressed)
+                packed = qCompress(raw, rawSize, 1);
+            const bool isPacked = isCompressed && packed.size() < rawSize;
+
+            GraphSnapshotChunk chunk{};
+            chunk.offset = quint64(file.pos());
+            chunk.pointCount = quint32(count);
+            chunk.storedSize = quint32(isPacked ? packed.size() : rawSize);
+            chunk.isCompressed = isPacked;
+            chunks.append(chunk);
+
+            if (isPacked)
+                file.write(packed);
+            else
+                file.write(reinterpret_cast<const char *>(raw), rawSize);
+            file.write(QByteArray(alignUp(file.pos()) - file.pos(), '\0'));
+        }
+    }
+
+    file.seek(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(GraphSnapshotHeader));
+    file.write(reinterpret_cast<const char *>(series.constData()), series.size() * sizeof(GraphSnapshotSeries));
+    file.write(reinterpret_cast<const char *>(chunks.constData()), chunks.size() * sizeof(GraphSnapshotChunk));
+
+    if (!file.commit()) {
+        qWarning("Error while writing snapshot file");
+        return false;
+    }
+    return true;
+}
+
+bool GraphWidget::loadSnapshot(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("Cannot open snapshot file for reading");
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    uchar *base = file.map(0, fileSize);
+    if (!base) {
+        qWarning("Cannot map snapshot file");
+        return false;
+    }
+
+    GraphSnapshotHeader header;
+    QVector<GraphSnapshotSeries> series;
+    QVector<QVector<QVector2D>> data;
+    const bool isOk = readSnapshot(base, fileSize, header, series, data);
+    file.unmap(base);
+
+    if (!isOk) {
+        qWarning("Invalid snapshot file");
+        return false;
+    }
+
+    makeCurrent();
+    graphs.clear();
+    graphs.reserve(series.size());
+    for (qsizetype i = 0; i < series.size(); ++i) {
+        const GraphSnapshotSeries &s = series[i];
+        // Ёмкость сохраняется как была; в VBO попадают последние capacity точек
+        graphs.emplace_back(std::move(data[i]), QVector3D(s.color[0], s.color[1], s.color[2]), s.lineWidth,
+                            static_cast<size_t>(s.capacity));
+        if (!s.isVisible)
+            graphs.back().setVisible(false);
+    }
+    doneCurrent();
+
+    slotIds.clear();
+    slotZOrders.clear();
+    graphSlots.clear();
+    nextGraphId = header.nextGraphId;
+    for (qsizetype i = 0; i < series.size(); ++i) {
+        slotIds.append(series[i].id);
+        slotZOrders.append(series[i].z);
+        graphSlots.insert(series[i].id, static_cast<int>(i));
+        nextGraphId = qMax(nextGraphId, series[i].id + 1);
+    }
+    sortDrawOrder();
+
+    // Масштаб ограничивается так же, как в setZoom
+    zoom = QVector2D(qMax(qAbs(header.zoom[0]), kMinZoom), qMax(qAbs(header.zoom[1]), kMinZoom));
+    offset = QVector2D(header.offset[0], header.offset[1]);
+    chartRect = QRectF(header.chartRect[0], header.chartRect[1], header.chartRect[2], header.chartRect[3]);
+    lastVisiblePeriod = header.lastVisiblePeriod;
+    isAutoScale = header.isAutoScale;
+    isFollow = header.isFollow;
+    isAutoScaleY = header.isAutoScaleY;
+    isPointsPresent = header.isPointsPresent;
+
+    markBoundariesChanged();
+    if (!isAutoScale)
+        emit autoScaleCleared();
+
+    update();
+    return true;
+}
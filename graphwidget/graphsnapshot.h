@@ -0,0 +1,54 @@
+#ifndef GRAPHSNAPSHOT_H
+#define GRAPHSNAPSHOT_H
+
+#include <QtGlobal>
+
+// Формат снимка GraphWidget (порядок байт хоста):
+//   GraphSnapshotHeader
+//   GraphSnapshotSeries[graphCount]
+//   GraphSnapshotChunk[...]           — таблицы блоков всех серий подряд
+//   данные блоков, каждый выровнен на 16 байт
+// Несжатый блок — массив QVector2D, сжатый — результат qCompress. При загрузке файл отображается
+// в память, но блоки копируются (или распаковываются) в память серий целиком.
+
+constexpr quint32 kGraphSnapshotMagic = 0x53535747; // "GWSS"
+constexpr quint32 kGraphSnapshotVersion = 1;
+constexpr quint32 kGraphSnapshotChunkPoints = 1 << 20;
+constexpr qint64 kGraphSnapshotAlignment = 16;
+
+struct GraphSnapshotHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 graphCount;
+    qint32 nextGraphId;
+    float zoom[2];
+    float offset[2];
+    float chartRect[4];     // x, y, width, height
+    float lastVisiblePeriod;
+    quint8 isAutoScale;
+    quint8 isFollow;
+    quint8 isAutoScaleY;
+    quint8 isPointsPresent;
+};
+
+struct GraphSnapshotSeries {
+    qint32 id;
+    qint32 z;
+    float color[3];
+    float lineWidth;
+    quint64 capacity;
+    quint64 pointCount;
+    quint64 chunkTableOffset;
+    quint32 chunkCount;
+    quint32 isVisible;
+};
+
+struct GraphSnapshotChunk {
+    quint64 offset;
+    quint32 pointCount;
+    quint32 storedSize;
+    quint32 isCompressed;
+    quint32 reserved;
+};
+
+#endif // GRAPHSNAPSHOT_H
@@ -0,0 +1,339 @@
+#include "graphstreamsource.h"
+#include "graphwidget.h"
+
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QTimer>
+#include <cstring>
+
+namespace {
+constexpr qint64 kSocketReadBufferSize = 4 * 1024 * 1024;
+constexpr quint64 kMaxBatchPoints = 1 << 16;
+constexpr qsizetype kFrameHeaderSize = sizeof(GraphStreamFrameHeader);
+
+static_assert(sizeof(QVector2D) == 2 * sizeof(float), "QVector2D must be two packed floats");
+
+bool isRingValid(const QSharedMemory &shm, const GraphStreamRingHeader *header) {
+    return header->magic == GraphStreamSource::kRingMagic
+           && header->capacity > 0
+           && static_cast<qsizetype>(sizeof(GraphStreamRingHeader) + header->capacity * sizeof(QVector2D)) <= shm.size();
+}
+}
+
+class GraphStreamWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit GraphStreamWorker(GraphStreamSource::Counters &counters) : m_counters{counters} {}
+
+    void openLocal(const QString &name);
+    void openLoopback(quint16 port);
+    void openSharedMemory(const QString &key, int pollIntervalMs);
+    void close();
+    void resume();
+
+signals:
+    void pointsDecoded(const QVector<QVector2D> &points);
+    void errorOccurred(const QString &message);
+
+private:
+    void readSocket();
+    void pollSharedMemory();
+    void decodeFrames();
+    void emitBatch(const QVector<QVector2D> &points);
+
+    GraphStreamSource::Counters &m_counters;
+    QIODevice *m_socket = nullptr;
+    QSharedMemory *m_shm = nullptr;
+    QTimer *m_pollTimer = nullptr;
+    QByteArray m_buffer;
+    bool m_paused = false;
+};
+
+void GraphStreamWorker::openLocal(const QString &name) {
+    close();
+
+    auto *socket = new QLocalSocket(this);
+    socket->setReadBufferSize(kSocketReadBufferSize);
+    connect(socket, &QLocalSocket::readyRead, this, &GraphStreamWorker::readSocket);
+    connect(socket, &QLocalSocket::errorOccurred, this, [this, socket] {
+        emit errorOccurred(socket->errorString());
+    });
+    m_socket = socket;
+    socket->connectToServer(name, QIODevice::ReadOnly);
+}
+
+void GraphStreamWorker::openLoopback(quint16 port) {
+    close();
+
+    auto *socket = new QTcpSocket(this);
+    // Ограниченный буфер чтения: пока воркер стоит на паузе, данные копятся в ядре,
+    // окно TCP закрывается и источник блокируется на записи
+    socket->setReadBufferSize(kSocketReadBufferSize);
+    connect(socket, &QTcpSocket::readyRead, this, &GraphStreamWorker::readSocket);
+    connect(socket, &QTcpSocket::errorOccurred, this, [this, socket] {
+        emit errorOccurred(socket->errorString());
+    });
+    m_socket = socket;
+    socket->connectToHost(QHostAddress::LocalHost, port, QIODevice::ReadOnly);
+}
+
+void GraphStreamWorker::openSharedMemory(const QString &key, int pollIntervalMs) {
+    close();
+
+    m_shm = new QSharedMemory(key, this);
+    if (!m_shm->attach(QSharedMemory::ReadWrite)) {
+        emit errorOccurred(m_shm->errorString());
+        delete m_shm;
+        m_shm = nullptr;
+        return;
+    }
+
+    m_pollTimer = new QTimer(this);
+    connect(m_pollTimer, &QTimer::timeout, this, &GraphStreamWorker::pollSharedMemory);
+    m_pollTimer->start(qMax(1, pollIntervalMs));
+}
+
+void GraphStreamWorker::close() {
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+    if (m_pollTimer) {
+        delete m_pollTimer;
+        m_pollTimer = nullptr;
+    }
+    if (m_shm) {
+        m_shm->detach();
+        delete m_shm;
+        m_shm = nullptr;
+    }
+    m_buffer.clear();
+    m_paused = false;
+}
+
+void GraphStreamWorker::resume() {
+    if (!m_paused || m_counters.pendingBatches >= m_counters.maxPendingBatches)
+        return;
+
+    m_paused = false;
+    if (m_socket)
+        readSocket();
+    else if (m_shm)
+        pollSharedMemory();
+}
+
+void GraphStreamWorker::readSocket() {
+    if (!m_socket || m_paused)
+        return;
+
+    m_buffer.append(m_socket->readAll());
+    decodeFrames();
+}
+
+void GraphStreamWorker::decodeFrames() {
+    QVector<QVector2D> batch;
+    qsizetype pos = 0;
+
+    while (m_buffer.size() - pos >= kFrameHeaderSize) {
+        GraphStreamFrameHeader header;
+        std::memcpy(&header, m_buffer.constData() + pos, kFrameHeaderSize);
+
+        if (header.magic != GraphStreamSource::kFrameMagic || header.count > GraphStreamSource::kMaxFramePoints) {
+            // Потеря синхронизации — пропускаем байты до следующего заголовка
+            ++m_counters.droppedFrames;
+            const QByteArray magic(reinterpret_cast<const char *>(&GraphStreamSource::kFrameMagic), sizeof(quint32));
+            const qsizetype next = m_buffer.indexOf(magic, pos + 1);
+            pos = (next < 0) ? m_buffer.size() - qsizetype(sizeof(quint32) - 1) : next;
+            continue;
+        }
+
+        const qsizetype frameSize = kFrameHeaderSize + qsizetype(header.count) * qsizetype(sizeof(QVector2D));
+        if (m_buffer.size() - pos < frameSize)
+            break;
+
+        const qsizetype offset = batch.size();
+        batch.resize(offset + header.count);
+        std::memcpy(batch.data() + offset, m_buffer.constData() + pos + kFrameHeaderSize,
+                    header.count * sizeof(QVector2D));
+        pos += frameSize;
+    }
+
+    m_buffer.remove(0, pos);
+    emitBatch(batch);
+}
+
+void GraphStreamWorker::pollSharedMemory() {
+    if (!m_shm || m_paused || !m_shm->lock())
+        return;
+
+    auto *header = static_cast<GraphStreamRingHeader *>(m_shm->data());
+    if (!isRingValid(*m_shm, header)) {
+        m_shm->unlock();
+        return;
+    }
+
+    const auto *ring = reinterpret_cast<const QVector2D *>(header + 1);
+    const quint64 capacity = header->capacity;
+    quint64 readIndex = header->readIndex;
+
+    if (header->writeIndex - readIndex > capacity) {
+        // Источник перезаписал непрочитанные точки
+        m_counters.droppedPoints += header->writeIndex - readIndex - capacity;
+        readIndex = header->writeIndex - capacity;
+    }
+
+    if (header->writeIndex == readIndex) {
+        m_shm->unlock();
+        return;
+    }
+
+    const quint64 count = std::min(header->writeIndex - readIndex, kMaxBatchPoints);
+    QVector<QVector2D> batch(static_cast<qsizetype>(count));
+
+    const quint64 start = readIndex % capacity;
+    const quint64 firstPart = std::min(count, capacity - start);
+    std::memcpy(batch.data(), ring + start, firstPart * sizeof(QVector2D));
+    std::memcpy(batch.data() + firstPart, ring, (count - firstPart) * sizeof(QVector2D));
+
+    header->readIndex = readIndex + count;
+    m_shm->unlock();
+
+    emitBatch(batch);
+}
+
+void GraphStreamWorker::emitBatch(const QVector<QVector2D> &points) {
+    if (points.isEmpty())
+        return;
+
+    m_counters.receivedPoints += points.size();
+    if (++m_counters.pendingBatches >= m_counters.maxPendingBatches)
+        m_paused = true;
+
+    emit pointsDecoded(points);
+}
+
+GraphStreamSource::GraphStreamSource(GraphWidget *widget, int graphId, QObject *parent)
+    : QObject(parent),
+    m_widget{widget},
+    m_graphId{graphId},
+    m_worker{new GraphStreamWorker(m_counters)} {
+
+    qRegisterMetaType<QVector<QVector2D>>();
+
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &GraphStreamWorker::pointsDecoded, this, &GraphStreamSource::onPointsDecoded);
+    connect(m_worker, &GraphStreamWorker::errorOccurred, this, &GraphStreamSource::errorOccurred);
+    m_thread.start();
+}
+
+GraphStreamSource::~GraphStreamSource() {
+    stop();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void GraphStreamSource::connectToLocalServer(const QString &name) {
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, name] { worker->openLocal(name); }, Qt::QueuedConnection);
+}
+
+void GraphStreamSource::connectToLoopback(quint16 port) {
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, port] { worker->openLoopback(port); }, Qt::QueuedConnection);
+}
+
+void GraphStreamSource::attachSharedMemory(const QString &key, int pollIntervalMs) {
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, key, pollIntervalMs] {
+        worker->openSharedMemory(key, pollIntervalMs);
+    }, Qt::QueuedConnection);
+}
+
+void GraphStreamSource::stop() {
+    QMetaObject::invokeMethod(m_worker, &GraphStreamWorker::close, Qt::QueuedConnection);
+}
+
+void GraphStreamSource::setMaxPendingBatches(int count) {
+    m_counters.maxPendingBatches = qMax(1, count);
+    QMetaObject::invokeMethod(m_worker, &GraphStreamWorker::resume, Qt::QueuedConnection);
+}
+
+quint64 GraphStreamSource::receivedPoints() const {
+    return m_counters.receivedPoints;
+}
+
+quint64 GraphStreamSource::droppedPoints() const {
+    return m_counters.droppedPoints;
+}
+
+quint64 GraphStreamSource::droppedFrames() const {
+    return m_counters.droppedFrames;
+}
+
+void GraphStreamSource::onPointsDecoded(const QVector<QVector2D> &points) {
+    --m_counters.pendingBatches;
+
+    if (m_widget)
+        m_widget->addPointsToGraph(m_graphId, points);
+
+    QMetaObject::invokeMethod(m_worker, &GraphStreamWorker::resume, Qt::QueuedConnection);
+}
+
+QByteArray GraphStreamSource::encodeFrame(const QVector<QVector2D> &points) {
+    const GraphStreamFrameHeader header{kFrameMagic, static_cast<quint32>(points.size())};
+
+    QByteArray frame;
+    frame.reserve(kFrameHeaderSize + points.size() * sizeof(QVector2D));
+    frame.append(reinterpret_cast<const char *>(&header), kFrameHeaderSize);
+    frame.append(reinterpret_cast<const char *>(points.constData()), points.size() * sizeof(QVector2D));
+    return frame;
+}
+
+bool GraphStreamSource::createRing(QSharedMemory &shm, quint32 capacity) {
+    if (capacity == 0 || !shm.create(sizeof(GraphStreamRingHeader) + capacity * sizeof(QVector2D)))
+        return false;
+
+    shm.lock();
+    auto *header = static_cast<GraphStreamRingHeader *>(shm.data());
+    *header = GraphStreamRingHeader{kRingMagic, capacity, 0, 0};
+    shm.unlock();
+    return true;
+}
+
+qint64 GraphStreamSource::writeToRing(QSharedMemory &shm, const QVector2D *points, qint64 count, bool isOverwrite) {
+    if (count <= 0 || !shm.lock())
+        return 0;
+
+    auto *header = static_cast<GraphStreamRingHeader *>(shm.data());
+    if (!isRingValid(shm, header)) {
+        shm.unlock();
+        return 0;
+    }
+
+    // Без перезаписи пишем только в свободное место: при заполненном кольце источник получает 0
+    // и должен подождать. С перезаписью пишутся все точки (из лишних — последние capacity),
+    // а непрочитанные потребитель учтёт в droppedPoints.
+    auto *ring = reinterpret_cast<QVector2D *>(header + 1);
+    const quint64 capacity = header->capacity;
+    quint64 toWrite;
+    quint64 skipped = 0;
+    if (isOverwrite) {
+        toWrite = std::min(static_cast<quint64>(count), capacity);
+        skipped = static_cast<quint64>(count) - toWrite;
+    } else {
+        const quint64 used = std::min(header->writeIndex - header->readIndex, capacity);
+        toWrite = std::min(static_cast<quint64>(count), capacity - used);
+    }
+
+    const quint64 start = (header->writeIndex + skipped) % capacity;
+    const quint64 firstPart = std::min(toWrite, capacity - start);
+    std::memcpy(ring + start, points + skipped, firstPart * sizeof(QVector2D));
+    std::memcpy(ring, points + skipped + firstPart, (toWrite - firstPart) * sizeof(QVector2D));
+
+    header->writeIndex += skipped + toWrite;
+    shm.unlock();
+    return static_cast<qint64>(skipped + toWrite);
+}
+
+#include "graphstreamsource.moc"
@@ -0,0 +1,83 @@
+#ifndef GRAPHSTREAMSOURCE_H
+#define GRAPHSTREAMSOURCE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QVector2D>
+#include <QSharedMemory>
+#include <atomic>
+
+class GraphWidget;
+class GraphStreamWorker;
+
+// Кадр потока: заголовок, за которым следуют count пар float (x, y) в порядке байт хоста
+struct GraphStreamFrameHeader {
+    quint32 magic;
+    quint32 count;
+};
+
+// Кольцевой буфер в разделяемой памяти: заголовок, за которым следуют capacity точек QVector2D.
+// writeIndex и readIndex — монотонно растущие счётчики точек, позиция в кольце — индекс % capacity.
+// Кольцо живёт в QSharedMemory: Qt строит системное имя сегмента из хэша ключа и защищает заголовок
+// семафором QSystemSemaphore. Поэтому источник тоже должен быть собран с Qt и писать в кольцо только
+// через createRing/writeToRing с тем же ключом; процесс без Qt к кольцу подключиться не сможет.
+struct GraphStreamRingHeader {
+    quint32 magic;
+    quint32 capacity;
+    quint64 writeIndex;
+    quint64 readIndex;
+};
+
+class GraphStreamSource : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr quint32 kFrameMagic = 0x46535747; // "GWSF"
+    static constexpr quint32 kRingMagic  = 0x52535747; // "GWSR"
+    static constexpr quint32 kMaxFramePoints = 1u << 20;
+
+    struct Counters {
+        std::atomic<quint64> receivedPoints{0};
+        std::atomic<quint64> droppedPoints{0};
+        std::atomic<quint64> droppedFrames{0};
+        std::atomic<int> pendingBatches{0};
+        std::atomic<int> maxPendingBatches{4};
+    };
+
+    explicit GraphStreamSource(GraphWidget *widget, int graphId, QObject *parent = nullptr);
+    ~GraphStreamSource() override;
+
+    void connectToLocalServer(const QString &name);
+    void connectToLoopback(quint16 port);
+    void attachSharedMemory(const QString &key, int pollIntervalMs = 5);
+    void stop();
+
+    void setMaxPendingBatches(int count);
+
+    quint64 receivedPoints() const;
+    quint64 droppedPoints() const;
+    quint64 droppedFrames() const;
+
+    // Вспомогательные функции для процесса-источника (или тестового генератора)
+    static QByteArray encodeFrame(const QVector<QVector2D> &points);
+    static bool createRing(QSharedMemory &shm, quint32 capacity);
+    static qint64 writeToRing(QSharedMemory &shm, const QVector2D *points, qint64 count, bool isOverwrite = false);
+
+signals:
+    void errorOccurred(const QString &message);
+
+private:
+    void onPointsDecoded(const QVector<QVector2D> &points);
+
+    QPointer<GraphWidget> m_widget;
+    int m_graphId;
+    Counters m_counters;
+    QThread m_thread;
+    GraphStreamWorker *m_worker;
+};
+
+#endif // GRAPHSTREAMSOURCE_H
@@ -1,12 +1,14 @@
 #include "graphwidget.h"
 
 #include <QMatrix4x4>
+#include <QMetaMethod>
 #include <QOpenGLShader>
 #include <QVector4D>
 #include <QtMath>
+#include <algorithm>
+#include <numeric>
 
 namespace {
-constexpr float kMinZoom = 1e-9f;
 constexpr float kPaddingRatioY = 0.02f;
 }
 
@@ -20,39 +22,221 @@ GraphWidget::GraphWidget(QWidget *parent)
 GraphWidget::~GraphWidget() {
     makeCurrent();
     m_gridVBO.destroy();
-    shaderProgram.removeAllShaders();
-    for (auto *g : graphs)
-        delete g;
+    shaders.clear();
+    graphs.clear();
     doneCurrent();
 }
 
 int GraphWidget::addGraph(const QVector<QVector2D> &data, const QVector3D color, float lineWidth, size_t capacity) {
     makeCurrent();
-    auto *gd = new GraphData{data, color, lineWidth, capacity};
-    graphs.append(gd);
+    graphs.emplace_back(data, color, lineWidth, capacity);
     doneCurrent();
-    return graphs.size() - 1;
+
+    const int graphId = nextGraphId++;
+    graphSlots.insert(graphId, static_cast<int>(graphs.size()) - 1);
+    slotIds.append(graphId);
+    slotZOrders.append(0);
+    sortDrawOrder();
+
+    return graphId;
 }
 int GraphWidget::addGraph(const QVector3D color, float lineWidth, size_t capacity) {
     return addGraph({}, color, lineWidth, capacity);
 }
 
-void GraphWidget::addPointToGraph(int graphIndex, const QVector2D &point) {
-    if (graphIndex < 0 || graphIndex >= graphs.size()) {
-        qWarning("Invalid graphIndex");
+void GraphWidget::addPointToGraph(int graphId, const QVector2D &point) {
+    const int slot = slotOf(graphId);
+    if (slot < 0)
+        return;
+
+    makeCurrent();
+    graphs[slot].appendPoint(point);
+    doneCurrent();
+
+    if (graphs[slot].isVisible()) {
+        uniteChartRect(point);
+        followChartRect();
+    }
+
+    if (isPointsAppendedConnected())
+        emit pointsAppended(graphId, {point});
+
+    update();
+}
+
+void GraphWidget::addPointsToGraph(int graphId, const QVector<QVector2D> &points) {
+    const int slot = slotOf(graphId);
+    if (slot < 0 || points.isEmpty())
+        return;
+
+    makeCurrent();
+    graphs[slot].appendPoints(points.constData(), points.size());
+    doneCurrent();
+
+    if (graphs[slot].isVisible()) {
+        for (const QVector2D &point : points)
+            uniteChartRect(point);
+        followChartRect();
+    }
+
+    emit pointsAppended(graphId, points);
+
+    update();
+}
+
+void GraphWidget::setGraphPoints(int graphId, const QVector<QVector2D> &points) {
+    const int slot = slotOf(graphId);
+    if (slot < 0)
         return;
+
+    makeCurrent();
+    graphs[slot].setPoints(points);
+    doneCurrent();
+
+    // Старые точки серии больше не должны влиять на границы
+    if (graphs[slot].isVisible())
+        recalcChartRect();
+
+    update();
+}
+
+// Одиночные точки заворачиваются в вектор только если на сигнал кто-то подписан
+bool GraphWidget::isPointsAppendedConnected() const {
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&GraphWidget::pointsAppended);
+    return isSignalConnected(signal);
+}
+
+void GraphWidget::removeGraph(int graphId) {
+    const int slot = slotOf(graphId);
+    if (slot < 0)
+        return;
+
+    const bool isAffectingBounds = graphs[slot].isVisible() && graphs[slot].size() > 0;
+
+    // VBO удаляемой серии освобождается сразу, пока контекст текущий
+    const int lastSlot = static_cast<int>(graphs.size()) - 1;
+    makeCurrent();
+    if (slot != lastSlot) {
+        graphs[slot] = std::move(graphs[lastSlot]);
+        slotIds[slot] = slotIds[lastSlot];
+        slotZOrders[slot] = slotZOrders[lastSlot];
+        graphSlots[slotIds[slot]] = slot;
     }
+    graphs.pop_back();
+    doneCurrent();
+
+    slotIds.removeLast();
+    slotZOrders.removeLast();
+    graphSlots.remove(graphId);
+    sortDrawOrder();
+
+    if (isAffectingBounds)
+        recalcChartRect();
+
+    update();
+}
+
+void GraphWidget::clearGraph(int graphId) {
+    const int slot = slotOf(graphId);
+    if (slot < 0)
+        return;
+
+    const bool isAffectingBounds = graphs[slot].isVisible() && graphs[slot].size() > 0;
+
+    makeCurrent();
+    graphs[slot].clear();
+    doneCurrent();
+
+    if (isAffectingBounds)
+        recalcChartRect();
+
+    emit graphCleared(graphId);
+    update();
+}
+
+void GraphWidget::setGraphVisible(int graphId, bool visible) {
+    const int slot = slotOf(graphId);
+    if (slot < 0 || graphs[slot].isVisible() == visible)
+        return;
 
     makeCurrent();
-    graphs[graphIndex]->appendPoint(point);
+    graphs[slot].setVisible(visible);
     doneCurrent();
 
+    if (graphs[slot].size() > 0)
+        recalcChartRect();
+
+    update();
+}
+
+bool GraphWidget::isGraphVisible(int graphId) const {
+    const int slot = slotOf(graphId);
+    return slot >= 0 && graphs[slot].isVisible();
+}
+
+void GraphWidget::setGraphZOrder(int graphId, int z) {
+    const int slot = slotOf(graphId);
+    if (slot < 0 || slotZOrders[slot] == z)
+        return;
+
+    slotZOrders[slot] = z;
+    sortDrawOrder();
+
+    update();
+}
+
+int GraphWidget::graphZOrder(int graphId) const {
+    const int slot = slotOf(graphId);
+    return (slot >= 0) ? slotZOrders[slot] : 0;
+}
+
+size_t GraphWidget::graphCapacity(int graphId) const {
+    const int slot = slotOf(graphId);
+    return (slot >= 0) ? graphs[slot].capacity() : 0;
+}
+
+int GraphWidget::slotOf(int graphId) const {
+    const int slot = graphSlots.value(graphId, -1);
+    if (slot < 0)
+        qWarning("Invalid graphId");
+    return slot;
+}
+
+// Серии рисуются по возрастанию z; при равном z — в порядке добавления
+void GraphWidget::sortDrawOrder() {
+    drawOrder.resize(static_cast<int>(graphs.size()));
+    std::iota(drawOrder.begin(), drawOrder.end(), 0);
+    std::sort(drawOrder.begin(), drawOrder.end(), [this](int a, int b) {
+        if (slotZOrders[a] != slotZOrders[b])
+            return slotZOrders[a] < slotZOrders[b];
+        return slotIds[a] < slotIds[b];
+    });
+}
+
+// Границы данных заново по всем видимым сериям; без точек isPointsPresent сбрасывается
+void GraphWidget::recalcChartRect() {
+    isPointsPresent = false;
+    for (const GraphData &graph : graphs) {
+        if (!graph.isVisible())
+            continue;
+        for (const QVector2D &point : graph.points())
+            uniteChartRect(point);
+    }
+
+    if (isPointsPresent)
+        followChartRect();
+}
+
+void GraphWidget::uniteChartRect(const QVector2D &point) {
     if (!isPointsPresent) {
         chartRect = QRectF(point.x(), point.y(), 0, 0);
         isPointsPresent = true;
     } else {
         chartRect = chartRect.united(QRectF(point.x(), point.y(), 0, 0));
     }
+}
+
+void GraphWidget::followChartRect() {
 // pointMinX, pointMaxX, pointMinY, pointMaxY - chartRect
 // maxX, minX, maxY, minY - widgetRect
     if (isAutoScale) {
@@ -73,8 +257,6 @@ void GraphWidget::addPointToGraph(int graphIndex, const QVector2D &point) {
             adjustByMaxY(chartRect.right() + paddingY, false);
         }
     }
-
-    update();
 }
 
 void GraphWidget::initializeGL() {
@@ -84,29 +266,8 @@ void GraphWidget::initializeGL() {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    const QString vertexShaderSource = R"(
-        #version 330 core
-        layout(location = 0) in vec2 position;
-        uniform mat4 transform;
-        void main() {
-            gl_Position = transform * vec4(position, 0.0, 1.0);
-        }
-    )";
-
-    const QString fragmentShaderSource = R"(
-        #version 330 core
-        uniform vec3 color;
-        out vec4 fragColor;
-        void main() {
-            fragColor = vec4(color, 1.0);
-        }
-    )";
-
-    if (!shaderProgram.addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource)
-        || !shaderProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource)
-        || !shaderProgram.link()) {
-        qWarning("Error while creating shader program");
-    }
+    // Программа собирается сразу, чтобы ошибки шейдеров были видны при инициализации
+    shaders.program();
 
     m_gridVBO.create();
     m_gridVBO.bind();
@@ -168,31 +329,35 @@ void GraphWidget::paintGL() {
 
     glClear(GL_COLOR_BUFFER_BIT);
 
-    shaderProgram.bind();
-    shaderProgram.setUniformValue("transform", transform);
+    QOpenGLShaderProgram *shaderProgram = shaders.program();
+    if (!shaderProgram)
+        return;
+
+    shaderProgram->bind();
+    shaderProgram->setUniformValue("transform", transform);
 
-    int positionLocation = shaderProgram.attributeLocation("position");
+    int positionLocation = shaderProgram->attributeLocation("position");
 
     // Рисование сетки
     m_gridVBO.bind();
-        shaderProgram.enableAttributeArray(positionLocation);
-        shaderProgram.setAttributeBuffer(positionLocation, GL_FLOAT, 0, 2, 0);
+        shaderProgram->enableAttributeArray(positionLocation);
+        shaderProgram->setAttributeBuffer(positionLocation, GL_FLOAT, 0, 2, 0);
 
         glLineWidth(0.7f);
-        shaderProgram.setUniformValue("color", QVector3D(0.7f, 0.7f, 0.7f));
+        shaderProgram->setUniformValue("color", QVector3D(0.7f, 0.7f, 0.7f));
         int gridVertexCount = m_gridVBO.size() / sizeof(QVector2D) - 4;
         glDrawArrays(GL_LINES, 0, gridVertexCount);
 
         glLineWidth(2.0f);
-        shaderProgram.setUniformValue("color", QVector3D(1, 1, 1));
+        shaderProgram->setUniformValue("color", QVector3D(1, 1, 1));
         glDrawArrays(GL_LINES, gridVertexCount, 4);
-        shaderProgram.disableAttributeArray(positionLocation);
+        shaderProgram->disableAttributeArray(positionLocation);
     m_gridVBO.release();
 
-    for (auto *graph : graphs)
-        graph->render(shaderProgram, positionLocation);
+    for (int slot : drawOrder)
+        graphs[slot].render(*shaderProgram, positionLocation);
 
-    shaderProgram.release();
+    shaderProgram->release();
 }
 
 void GraphWidget::mousePressEvent(QMouseEvent *event) {
@@ -260,8 +425,13 @@ void GraphWidget::clear() {
     emit autoScaleCleared();
     isPointsPresent = false;
 
-    for (auto *graph : graphs)
-        graph->clear();
+    makeCurrent();
+    for (auto &graph : graphs)
+        graph.clear();
+    doneCurrent();
+
+    for (int graphId : slotIds)
+        emit graphCleared(graphId);
 
     update();
 }
@@ -337,6 +507,11 @@ void GraphWidget::setAutoScale(bool is) {
     update();
 }
 
+// Действует, если вызвать до initializeGL (или после пересоздания контекста)
+void GraphWidget::setShaderDiskCacheEnabled(bool is) {
+    shaders.setDiskCacheEnabled(is);
+}
+
 void GraphWidget::setZoom(QVector2D newZoom, bool isToUpdate) {
     zoom.setX( qMax(qAbs(newZoom.x()), kMinZoom) );
     zoom.setY( qMax(qAbs(newZoom.y()), kMinZoom) );
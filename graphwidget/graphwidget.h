@@ -13,7 +13,10 @@
 #include <QVector2D>
 #include <QVector3D>
 #include <QRectF>
+#include <QHash>
+#include <vector>
 #include "graphdata.h"
+#include "graphshadercache.h"
 
 inline QRectF operator/(const QRectF &rect, const QVector2D &zoom) {
     return QRectF(rect.left() / zoom.x(),
@@ -64,9 +67,23 @@ public:
     int addGraph(const QVector<QVector2D> &data, const QVector3D color = {1.0f, 0.0f, 1.0f}, float lineWidth = 1.0f, size_t capacity = 100000);
     int addGraph(const QVector3D color = {1.0f, 0.0f, 1.0f}, float lineWidth = 1.0f, size_t capacity = 100000);
 
-    void addPointToGraph(int graphIndex, const QVector2D &point);
+    void addPointToGraph(int graphId, const QVector2D &point);
+    void addPointsToGraph(int graphId, const QVector<QVector2D> &points);
+    void setGraphPoints(int graphId, const QVector<QVector2D> &points);
+
+    void removeGraph(int graphId);
+    void clearGraph(int graphId);
+
+    void setGraphVisible(int graphId, bool visible);
+    bool isGraphVisible(int graphId) const;
+
+    void setGraphZOrder(int graphId, int z);
+    int graphZOrder(int graphId) const;
+
+    size_t graphCapacity(int graphId) const;
 
     void setAutoScale(bool is);
+    void setShaderDiskCacheEnabled(bool is);
 
     void adjustByMinX(float minX, bool isToUpdate = true);
     void adjustByMinY(float minY, bool isToUpdate = true);
@@ -83,10 +100,15 @@ public:
 
     void clear();
 
+    bool saveSnapshot(const QString &fileName, bool isCompressed = false) const;
+    bool loadSnapshot(const QString &fileName);
+
 signals:
     void initialized();
     void boundariesChanged(float minX, float maxX, float minY, float maxY);
     void autoScaleCleared();
+    void pointsAppended(int graphId, const QVector<QVector2D> &points);
+    void graphCleared(int graphId);
 
 protected:
     void initializeGL() override;
@@ -99,8 +121,17 @@ protected:
     void mouseReleaseEvent(QMouseEvent *event) override;
 
 private:
-    QOpenGLShaderProgram shaderProgram;
-    QVector<GraphData*> graphs;
+    static constexpr float kMinZoom = 1e-9f;
+
+    GraphShaderCache shaders;
+    // Таблица серий: данные лежат подряд, идентификатор серии → слот через graphSlots.
+    // При удалении последний слот переносится на место удалённого.
+    std::vector<GraphData> graphs;
+    QVector<int> slotIds;
+    QVector<int> slotZOrders;
+    QVector<int> drawOrder;
+    QHash<int, int> graphSlots;
+    int nextGraphId = 0;
     QOpenGLBuffer m_gridVBO;
 
     QVector2D grid;
@@ -119,6 +150,12 @@ private:
     bool isAutoScaleY = false;
     float lastVisiblePeriod = 0.0f;
 
+    int slotOf(int graphId) const;
+    void sortDrawOrder();
+    bool isPointsAppendedConnected() const;
+    void recalcChartRect();
+    void uniteChartRect(const QVector2D &point);
+    void followChartRect();
     void evalBoundaries();
     void markBoundariesChanged();
 };
@@ -7,9 +7,25 @@ TARGET = graphwidget
 include(../dest.pri)
 
 HEADERS +=  graphwidget.h \
-            graphdata.h
+            graphdata.h \
+            graphshadercache.h \
+            graphsnapshot.h
 
 SOURCES +=  graphwidget.cpp \
-            graphdata.cpp
+            graphdata.cpp \
+            graphshadercache.cpp \
+            graphsnapshot.cpp
+
+# Модуль приёма потока (сокет / разделяемая память); отключается через CONFIG += no_graphstream
+!no_graphstream {
+    QT += network
+
+    HEADERS +=  graphstreamsource.h
+    SOURCES +=  graphstreamsource.cpp
+}
+
+# Производные серии (скользящее среднее, огибающая, прореживание, спектр)
+HEADERS +=  graphderivedseries.h
+SOURCES +=  graphderivedseries.cpp
 
 INCLUDEPATH += $$PWD